@@ -2,6 +2,7 @@
 #include <stdio.h>
 
 void update_is_done(CIterator *);
+void advance_current(CIterator *);
 
 /* Create a new empty CIterator. */
 CIterator *citerator_new(void) {
@@ -13,6 +14,10 @@ CIterator *citerator_new(void) {
     citer->current = NULL;
     citer->current_pos = 0;
     citer->is_done = 0;
+    citer->source = NULL;
+    citer->refill = NULL;
+    citer->source_free = NULL;
+    citer->base_pos = 0;
     return citer;
 }
 
@@ -43,8 +48,7 @@ void citerator_go_next(CIterator *self) {
     if (!self)
         return;
     else if (!citerator_is_done(self)) {
-        self->current = self->root_pointer[++self->current_pos];
-        update_is_done(self);
+        advance_current(self);
     } else {
         self->current_pos = 0;
         self->current = NULL;
@@ -59,8 +63,7 @@ void citerator_go_next_and_consume(CIterator *self) {
     if (!self)
         return;
     else if (!citerator_is_done(self)) {
-        self->current = self->root_pointer[++self->current_pos];
-        update_is_done(self);
+        advance_current(self);
     }
     if (citerator_is_done(self))
         citerator_clear(self);
@@ -73,8 +76,7 @@ CIterator *citerator_go_next_or_free(CIterator *self) {
     if (!self)
         return NULL;
     else if (!citerator_is_done(self)) {
-        self->current = self->root_pointer[++self->current_pos];
-        update_is_done(self);
+        advance_current(self);
     }
     if (citerator_is_done(self)) {
         citerator_destroy(self);
@@ -85,17 +87,27 @@ CIterator *citerator_go_next_or_free(CIterator *self) {
 
 /* Returns the position (0 based) of the current item on iteration. Note that this function returns
  * 0 if the self pointer is null. */
-size_t citerator_get_index(CIterator *self) { return self ? self->current_pos : 0; }
+size_t citerator_get_index(CIterator *self) {
+    return self ? self->base_pos + self->current_pos : 0;
+}
 
 /* Peeks the current item being pointed. */
 void *citerator_peek(CIterator *self) { return self ? self->current : NULL; }
 
 /* Resets the CIterator `current` field to the start of the iter
- * queue. Works only when `root_pointer` isn't NULL. */
+ * queue. Works only when `root_pointer` isn't NULL. Lazy sources are
+ * asked to reload their first chunk. */
 void citerator_reset(CIterator *self) {
     if (!self)
         return;
-    else if (self->root_pointer) {
+    else if (self->refill) {
+        if (!self->root_pointer || !self->refill(self, 1))
+            return;
+        self->current = self->root_pointer[0];
+        self->current_pos = 0;
+        self->base_pos = 0;
+        self->is_done = 0;
+    } else if (self->root_pointer) {
         self->current = self->root_pointer[0];
         self->current_pos = 0;
         self->is_done = 0;
@@ -120,8 +132,14 @@ void citerator_clear(CIterator *self) {
         free(self->root_pointer);
         self->root_pointer = NULL;
     }
+    if (self->source && self->source_free)
+        self->source_free(self->source);
+    self->source = NULL;
+    self->refill = NULL;
+    self->source_free = NULL;
     self->queue_len = 0;
     self->current_pos = 0;
+    self->base_pos = 0;
     self->is_done = 1;
 }
 
@@ -132,3 +150,16 @@ void update_is_done(CIterator *self) {
     else if (!self->is_done && self->current_pos >= self->queue_len)
         self->is_done = 1;
 }
+
+/* Private function that moves the `current` pointer one step forward, asking the lazy source (if
+ * any) for a new chunk when the queue end is reached. */
+void advance_current(CIterator *self) {
+    size_t len = self->queue_len;
+    if (++self->current_pos >= len && self->refill && self->refill(self, 0)) {
+        self->base_pos += len;
+        self->current_pos = 0;
+    }
+    self->current =
+        self->current_pos < self->queue_len ? self->root_pointer[self->current_pos] : NULL;
+    update_is_done(self);
+}
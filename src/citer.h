@@ -4,7 +4,7 @@
 #include <stdlib.h>
 
 // Iterator type abstraction.
-typedef struct {
+typedef struct _CIterator {
     // A pointer to the root of the Iterator (allow late free and/or
     // iteration reset).
     void **root_pointer;
@@ -16,6 +16,21 @@ typedef struct {
     size_t current_pos;
     // If the iteration has reached the end.
     int is_done;
+    // Optional data owned by the CIterator (NULL for plain queues):
+    // storage behind the queue items and/or a lazy source that feeds
+    // the queue chunk by chunk. Chunks reuse the same buffer, so a pointer
+    // returned by `citerator_peek` may be invalidated by any of the
+    // `go_next` functions: consumers that keep items must copy them.
+    void *source;
+    // Loads the next chunk of `source` into the queue (the first one
+    // when the int flag is set). Returns 0 when the source is exhausted.
+    // When it isn't NULL, peeked pointers only last until the next move.
+    int (*refill)(struct _CIterator *, int);
+    // Function used to free the `source` when the CIterator is cleared.
+    void (*source_free)(void *);
+    // The position of the first queue element over the whole iteration
+    // (only moves when a lazy source is being used).
+    size_t base_pos;
 } CIterator;
 
 CIterator *citerator_new(void);
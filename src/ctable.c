@@ -0,0 +1,222 @@
+#include "ctable.h"
+#include <string.h>
+
+/* Note: a CTable stores each field of the records in its own contiguous array, so scanning a
+ * single field only reads that field bytes (the other fields never reach the cache). Each
+ * projected CIterator item is a `void **` holding one value pointer per selected column (NULL
+ * when the value is null). */
+
+/* State of the CIterator lazy source. */
+typedef struct {
+    /* The table being iterated (not owned). */
+    CTable *table;
+    /* The projected column indexes. */
+    size_t *columns;
+    /* The amount of projected columns. */
+    size_t column_count;
+    /* The first row of the next chunk. */
+    size_t next_row;
+    /* Reusable projection buffer (`column_count` pointers per chunk row). */
+    void **rows;
+} CTableSource;
+
+int ctable_is_null(CColumn *, size_t);
+int refill_ctable_projection(CIterator *, int);
+void ctable_source_free(void *);
+
+/* Creates a new CTable (without columns) with the given amount of rows. */
+CTable *ctable_new(size_t row_count) {
+    CTable *table = (CTable *)malloc(sizeof(CTable));
+    if (!table)
+        return NULL;
+    table->columns = NULL;
+    table->column_count = 0;
+    table->row_count = row_count;
+    return table;
+}
+
+/* Adds a new column (zero filled) whose values have `elem_size` bytes. Values of a nullable column
+ * start as null. Returns 1 on success, 0 otherwise. */
+int ctable_add_column(CTable *self, size_t elem_size, int nullable) {
+    if (!self || elem_size == 0)
+        return 0;
+    CColumn *columns =
+        (CColumn *)realloc(self->columns, (self->column_count + 1) * sizeof(CColumn));
+    if (!columns)
+        return 0;
+    self->columns = columns;
+    CColumn *column = &columns[self->column_count];
+    column->elem_size = elem_size;
+    column->data = calloc(self->row_count ? self->row_count : 1, elem_size);
+    column->nulls = NULL;
+    if (nullable) {
+        size_t bytes = (self->row_count + 7) / 8;
+        column->nulls = (uint8_t *)malloc(bytes ? bytes : 1);
+        if (column->nulls)
+            memset(column->nulls, 0xff, bytes);
+    }
+    if (!column->data || (nullable && !column->nulls)) {
+        free(column->data);
+        free(column->nulls);
+        return 0;
+    }
+    self->column_count++;
+    return 1;
+}
+
+/* Copies the value into the given row/column (clearing its null bit). Does nothing if any index
+ * is out of range. */
+void ctable_set(CTable *self, size_t row, size_t col, void *value) {
+    if (!self || !value || row >= self->row_count || col >= self->column_count)
+        return;
+    CColumn *column = &self->columns[col];
+    memcpy((char *)column->data + row * column->elem_size, value, column->elem_size);
+    if (column->nulls)
+        column->nulls[row / 8] &= (uint8_t)~(1u << (row % 8));
+}
+
+/* Sets the given row/column as null. Does nothing if the column isn't nullable. */
+void ctable_set_null(CTable *self, size_t row, size_t col) {
+    if (!self || row >= self->row_count || col >= self->column_count)
+        return;
+    CColumn *column = &self->columns[col];
+    if (column->nulls)
+        column->nulls[row / 8] |= (uint8_t)(1u << (row % 8));
+}
+
+/* Returns a pointer to the value at the given row/column or NULL if the value is null (or out of
+ * range). */
+void *ctable_get(CTable *self, size_t row, size_t col) {
+    if (!self || row >= self->row_count || col >= self->column_count)
+        return NULL;
+    CColumn *column = &self->columns[col];
+    if (ctable_is_null(column, row))
+        return NULL;
+    return (char *)column->data + row * column->elem_size;
+}
+
+/* Returns the raw column values starting at the `start` row (batch/vectorized processing) and
+ * writes the amount of available values into `len`. Null values aren't skipped, so check
+ * `ctable_column_nulls` when the column is nullable. */
+void *ctable_column_slice(CTable *self, size_t col, size_t start, size_t *len) {
+    if (len)
+        *len = 0;
+    if (!self || col >= self->column_count || start >= self->row_count)
+        return NULL;
+    CColumn *column = &self->columns[col];
+    if (len)
+        *len = self->row_count - start;
+    return (char *)column->data + start * column->elem_size;
+}
+
+/* Returns the column null bitmap (bit `row % 8` of byte `row / 8`) or NULL if the column isn't
+ * nullable. */
+uint8_t *ctable_column_nulls(CTable *self, size_t col) {
+    if (!self || col >= self->column_count)
+        return NULL;
+    return self->columns[col].nulls;
+}
+
+/* Destroy the table + return a NULL pointer. */
+CTable *ctable_destroy(CTable *self) {
+    if (!self)
+        return NULL;
+    for (size_t i = 0; i < self->column_count; i++) {
+        free(self->columns[i].data);
+        free(self->columns[i].nulls);
+    }
+    free(self->columns);
+    free(self);
+    return NULL;
+}
+
+/* Push a projection of the table (only the given columns, in the given order) into a CIterator.
+ * The rows are projected one chunk at a time into a buffer owned by the CIterator, so a peeked
+ * item is only valid until the iteration leaves its chunk. The table must outlive the CIterator. */
+void push_ctable_projection_into_citerator(CIterator *citerator,
+                                           CTable *table,
+                                           size_t *columns,
+                                           size_t column_count) {
+    if (!citerator || !table || !columns || column_count == 0)
+        return;
+    citerator_clear(citerator);
+    for (size_t i = 0; i < column_count; i++)
+        if (columns[i] >= table->column_count)
+            return;
+    if (table->row_count == 0)
+        return;
+    CTableSource *source = (CTableSource *)malloc(sizeof(CTableSource));
+    void ***queue = (void ***)malloc(CTABLE_CHUNK_LEN * sizeof(void **));
+    if (!source || !queue) {
+        free(source);
+        free(queue);
+        return;
+    }
+    source->table = table;
+    source->column_count = column_count;
+    source->next_row = 0;
+    source->columns = (size_t *)malloc(column_count * sizeof(size_t));
+    source->rows = (void **)malloc(CTABLE_CHUNK_LEN * column_count * sizeof(void *));
+    if (!source->columns || !source->rows) {
+        ctable_source_free(source);
+        free(queue);
+        return;
+    }
+    memcpy(source->columns, columns, column_count * sizeof(size_t));
+    // the queue addresses never change, only the projected pointers behind them
+    for (size_t i = 0; i < CTABLE_CHUNK_LEN; i++)
+        queue[i] = &source->rows[i * column_count];
+    citerator->root_pointer = (void **)queue;
+    citerator->source = source;
+    citerator->refill = refill_ctable_projection;
+    citerator->source_free = ctable_source_free;
+    refill_ctable_projection(citerator, 1);
+    citerator->current = citerator->root_pointer[0];
+    citerator->is_done = 0;
+}
+
+/* Creates a new CIterator from a table projection. */
+CIterator *new_citerator_from_ctable_projection(CTable *table,
+                                                size_t *columns,
+                                                size_t column_count) {
+    CIterator *citerator = citerator_new();
+    if (citerator)
+        push_ctable_projection_into_citerator(citerator, table, columns, column_count);
+    return citerator;
+}
+
+/* Private function that returns if the value at the given row is null. */
+int ctable_is_null(CColumn *column, size_t row) {
+    return column->nulls ? (column->nulls[row / 8] >> (row % 8)) & 1 : 0;
+}
+
+/* Private CIterator refill function: projects the next chunk of rows into the source buffer. The
+ * buffer is filled column by column, so each column is still read sequentially. */
+int refill_ctable_projection(CIterator *citer, int restart) {
+    CTableSource *source = (CTableSource *)citer->source;
+    if (restart)
+        source->next_row = 0;
+    size_t start = source->next_row, count = source->table->row_count - start;
+    if (start >= source->table->row_count)
+        return 0;
+    if (count > CTABLE_CHUNK_LEN)
+        count = CTABLE_CHUNK_LEN;
+    for (size_t c = 0; c < source->column_count; c++) {
+        CColumn *column = &source->table->columns[source->columns[c]];
+        char *value = (char *)column->data + start * column->elem_size;
+        for (size_t i = 0; i < count; i++, value += column->elem_size)
+            source->rows[i * source->column_count + c] =
+                ctable_is_null(column, start + i) ? NULL : value;
+    }
+    source->next_row += count;
+    citer->queue_len = count;
+    return 1;
+}
+
+/* Private function that frees the CIterator lazy source. */
+void ctable_source_free(void *data) {
+    CTableSource *source = (CTableSource *)data;
+    free(source->columns);
+    free(source->rows);
+    free(source);
+}
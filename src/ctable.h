@@ -0,0 +1,42 @@
+#ifndef _CTABLE_H_
+#define _CTABLE_H_
+
+#include "citer.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Amount of rows projected per CIterator chunk. */
+#define CTABLE_CHUNK_LEN 64
+
+/* A CTable column: the values of every row stored side by side. */
+typedef struct {
+    /* The column values (`elem_size` bytes each). */
+    void *data;
+    /* The size of a single value. */
+    size_t elem_size;
+    /* Null bitmap (bit set means null value) or NULL if the column isn't nullable. */
+    uint8_t *nulls;
+} CColumn;
+
+/* Columnar (struct of arrays) table with a fixed amount of rows. */
+typedef struct {
+    /* The table columns. */
+    CColumn *columns;
+    /* The amount of columns. */
+    size_t column_count;
+    /* The amount of rows (shared by every column). */
+    size_t row_count;
+} CTable;
+
+CTable *ctable_new(size_t);
+int ctable_add_column(CTable *, size_t, int);
+void ctable_set(CTable *, size_t, size_t, void *);
+void ctable_set_null(CTable *, size_t, size_t);
+void *ctable_get(CTable *, size_t, size_t);
+void *ctable_column_slice(CTable *, size_t, size_t, size_t *);
+uint8_t *ctable_column_nulls(CTable *, size_t);
+CTable *ctable_destroy(CTable *);
+void push_ctable_projection_into_citerator(CIterator *, CTable *, size_t *, size_t);
+CIterator *new_citerator_from_ctable_projection(CTable *, size_t *, size_t);
+
+#endif
@@ -1,11 +1,17 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "b_tree.h"
 #include "citer.h"
+#include "ctable.h"
 #include "my_string.h"
+#include "packed_ints.h"
 #include "posints.h"
+#include "quantile.h"
+#include "radix.h"
+#include "top_k.h"
 
 #define REPO_URL "https://github.com/nasccped/citer-example"
 #define HELP_FLAG "--help"
@@ -16,9 +22,16 @@
 #define MAGENTA "\x1b[95m"
 #define CYAN "\x1b[96m"
 #define WHITE "\x1b[97m"
+#define BENCH_LEN 1000000
 
 typedef enum { NOTE, ERROR, HELP } Tag;
 typedef void (*PartFunction)(void);
+/* A "wide" record (64 bytes) used to compare row and columnar layouts. */
+typedef struct {
+    int id, qty;
+    float price, weight;
+    double extra[6];
+} Record;
 
 void usage_tip(void);
 void print_help(void);
@@ -28,16 +41,25 @@ void part1(void);
 void part2(void);
 void part3(void);
 void part4(void);
+void part5(void);
+void part6(void);
+void part7(void);
+void part8(void);
 
 int float_comp(float *, float *);
+int int_comp(int *, int *);
 void ghost_free(void);
 
-static PartFunction parts[] = { part1, part2, part3, part4 };
+static PartFunction parts[] = { part1, part2, part3, part4, part5, part6, part7, part8 };
 static char *descriptions[] = {
     "CIterator constructor and destructor",
     "CIterator set data and create from",
     "CIterator cursor move",
     "CIterator getters",
+    "CIterator sorted numeric views",
+    "CIterator over compressed posints",
+    "CIterator top-k and quantiles",
+    "CIterator over columnar tables",
 };
 
 int main(int argc, char *argv[]) {
@@ -317,6 +339,321 @@ void part4(void) {
     b_tree_destroy(tree);
 }
 
+void part5(void) {
+    printf("Part 4 used a %sBTree%s just to iterate floats in order. For numeric\n", CYAN, RESET);
+    printf("data, the `%snew_citerator_sorted_from_*%s` functions build a sorted\n", CYAN, RESET);
+    printf("CIterator straight from the array (radix sort, no comparer):\n\n");
+    CIterator *citer =
+        new_citerator_sorted_from_floats(MY_FLOATS, sizeof(MY_FLOATS) / sizeof(MY_FLOATS[0]));
+    printf("    %sfloats%s -> ", YELLOW, RESET);
+    for (; citer; citer = citerator_go_next_or_free(citer))
+        printf("%.3f ", *(float *)citerator_peek(citer));
+    printf("\n    %sposints%s -> ", YELLOW, RESET);
+    for (citer = new_citerator_sorted_from_posints((int[]){ 29, 2, 17, 5, 23, 3, -1 }); citer;
+         citer = citerator_go_next_or_free(citer))
+        printf("%d ", *(int *)citerator_peek(citer));
+    printf("\n\n");
+    float *floats = (float *)malloc(BENCH_LEN * sizeof(float));
+    if (!floats)
+        return;
+    srand(42);
+    for (size_t i = 0; i < BENCH_LEN; i++)
+        floats[i] = (float)rand() / (float)RAND_MAX * 1000.0f - 500.0f;
+    int (*comp)(void *, void *) = (int (*)(void *, void *))float_comp;
+    void (*free_func)(void *) = (void (*)(void *))ghost_free;
+    clock_t start = clock();
+    BTree *tree = b_tree_new(comp, free_func);
+    for (size_t i = 0; i < BENCH_LEN; i++)
+        b_tree_insert(tree, &floats[i]);
+    citer = new_citerator_from_b_tree(tree);
+    double tree_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    citerator_destroy(citer);
+    b_tree_destroy(tree);
+    start = clock();
+    citer = new_citerator_sorted_from_floats(floats, BENCH_LEN);
+    double radix_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    citerator_destroy(citer);
+    free(floats);
+    printf("Sorting %s%d%s random floats:\n", GREEN, BENCH_LEN, RESET);
+    printf("  %sBTree%s + `%spush_tree_into_citerator%s`: %s%.3fs%s\n",
+           CYAN,
+           RESET,
+           CYAN,
+           RESET,
+           RED,
+           tree_secs,
+           RESET);
+    printf("  `%snew_citerator_sorted_from_floats%s`: %s%.3fs%s\n\n",
+           CYAN,
+           RESET,
+           GREEN,
+           radix_secs,
+           RESET);
+    print_tag(stdout,
+              NOTE,
+              "the sorted views point into the source array, so it must\n"
+              "outlive the CIterator (the same goes for the other sources).\n");
+}
+
+void part6(void) {
+    int *ids = (int *)malloc((BENCH_LEN + 1) * sizeof(int));
+    if (!ids)
+        return;
+    srand(42);
+    ids[0] = 0;
+    for (size_t i = 1; i < BENCH_LEN; i++)
+        ids[i] = ids[i - 1] + 1 + rand() % 16;
+    ids[BENCH_LEN] = -1;
+    PackedInts *packed = packed_ints_new(ids);
+    if (!packed) {
+        free(ids);
+        return;
+    }
+    printf("A posints CIterator needs the %sint%s itself + a %squeue pointer%s for\n",
+           CYAN,
+           RESET,
+           CYAN,
+           RESET);
+    printf("each item. A %sPackedInts%s stores %sdeltas%s (bit packed, in blocks of\n",
+           CYAN,
+           RESET,
+           GREEN,
+           RESET);
+    printf("%d ints) and the CIterator decodes one block at a time:\n\n", PACKED_INTS_BLOCK_LEN);
+    printf("  %d sorted IDs as posints + queue: %s%zu bytes%s\n",
+           BENCH_LEN,
+           RED,
+           BENCH_LEN * (sizeof(int) + sizeof(void *)),
+           RESET);
+    printf("  %d sorted IDs as PackedInts: %s%zu bytes%s\n\n",
+           BENCH_LEN,
+           GREEN,
+           packed_ints_size(packed),
+           RESET);
+    CIterator *citer = new_citerator_from_packed_ints(packed);
+    size_t mismatches = 0;
+    clock_t start = clock();
+    for (; !citerator_is_done(citer); citerator_go_next(citer))
+        mismatches += *(int *)citerator_peek(citer) != ids[citerator_get_index(citer)];
+    double citer_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    citerator_destroy(citer);
+    int block[PACKED_INTS_BLOCK_LEN];
+    long long sum = 0;
+    start = clock();
+    for (size_t b = 0; b < packed->block_count; b++) {
+        size_t count = packed_ints_decode_block(packed, b, block);
+        for (size_t i = 0; i < count; i++)
+            sum += block[i];
+    }
+    double block_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Decoding them back (%s%zu%s mismatches, sum %lld):\n",
+           mismatches ? RED : GREEN,
+           mismatches,
+           RESET,
+           sum);
+    printf("  through the CIterator: %s%.4fs%s\n", CYAN, citer_secs, RESET);
+    printf("  through `%spacked_ints_decode_block%s`: %s%.4fs%s\n\n",
+           CYAN,
+           RESET,
+           CYAN,
+           block_secs,
+           RESET);
+    print_tag(stdout,
+              NOTE,
+              "the peeked pointer lives in the CIterator decode buffer,\n"
+              "so it's only valid until the iteration leaves its block!\n");
+    packed_ints_destroy(packed);
+    free(ids);
+}
+
+void part7(void) {
+    size_t half = BENCH_LEN / 2;
+    int *latencies = (int *)malloc((BENCH_LEN + 1) * sizeof(int));
+    int *shards[] = { (int *)malloc((half + 1) * sizeof(int)),
+                      (int *)malloc((BENCH_LEN - half + 1) * sizeof(int)) };
+    if (!latencies || !shards[0] || !shards[1]) {
+        free(latencies);
+        free(shards[0]);
+        free(shards[1]);
+        return;
+    }
+    // latencies in tenths of ms (a few slow requests)
+    srand(42);
+    for (size_t i = 0; i < BENCH_LEN; i++)
+        latencies[i] = rand() % 1000 + (rand() % 50 == 0 ? 4000 + rand() % 60000 : 0);
+    latencies[BENCH_LEN] = -1;
+    memcpy(shards[0], latencies, half * sizeof(int));
+    shards[0][half] = -1;
+    memcpy(shards[1], &latencies[half], (BENCH_LEN - half + 1) * sizeof(int));
+    int (*comp)(void *, void *) = (int (*)(void *, void *))int_comp;
+    printf("Getting the largest items or percentiles doesn't require a %sBTree%s\n", CYAN, RESET);
+    printf("holding every item. %sTopK%s and %sQuantileSketch%s consume any CIterator\n",
+           CYAN,
+           RESET,
+           CYAN,
+           RESET);
+    printf("in a %ssingle pass%s with bounded memory (they copy what they keep,\n", GREEN, RESET);
+    printf("so even the block decoding %sPackedInts%s CIterator works).\n\n", CYAN, RESET);
+    // each shard is consumed on its own (like threads would) and then merged
+    TopK *tops[2];
+    QuantileSketch *sketches[2];
+    for (size_t s = 0; s < 2; s++) {
+        tops[s] = top_k_new(5, sizeof(int), comp);
+        sketches[s] = quantile_sketch_new(200, sizeof(int), comp);
+        PackedInts *packed = packed_ints_new(shards[s]);
+        CIterator *citer = new_citerator_from_packed_ints(packed);
+        top_k_consume(tops[s], citer);
+        citerator_reset(citer);
+        quantile_sketch_consume(sketches[s], citer);
+        citerator_destroy(citer);
+        packed_ints_destroy(packed);
+    }
+    top_k_merge(tops[0], tops[1]);
+    quantile_sketch_merge(sketches[0], sketches[1]);
+    PackedInts *packed = packed_ints_new(latencies);
+    CIterator *citer = new_citerator_from_packed_ints(packed);
+    CIterator *whole = citerator_top_k(citer, 5, sizeof(int), comp);
+    citerator_destroy(citer);
+    packed_ints_destroy(packed);
+    printf("  %stop_k_merge%s (k = 5)     -> ", CYAN, RESET);
+    citer = citerator_new();
+    size_t mismatches = 0;
+    for (push_top_k_into_citerator(citer, tops[0]); citer;
+         citer = citerator_go_next_or_free(citer)) {
+        int value = *(int *)citerator_peek(citer);
+        mismatches += !whole || value != *(int *)citerator_peek(whole);
+        printf("%.1f ", value / 10.0);
+        whole = citerator_go_next_or_free(whole);
+    }
+    citerator_destroy(whole);
+    printf("\n  %sciterator_top_k%s (k = 5) -> %s%s%s\n\n",
+           CYAN,
+           RESET,
+           mismatches ? RED : GREEN,
+           mismatches ? "different" : "same items",
+           RESET);
+    printf("  %squantile_sketch_query%s (merged) vs exact (sorted view):\n", CYAN, RESET);
+    double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    size_t quantile_count = sizeof(quantiles) / sizeof(quantiles[0]), q = 0;
+    for (citer = new_citerator_sorted_from_posints(latencies); citer && q < quantile_count;
+         citer = citerator_go_next_or_free(citer)) {
+        if (citerator_get_index(citer) != (size_t)(quantiles[q] * (BENCH_LEN - 1)))
+            continue;
+        printf("    p%-5g %s%6.1f%s vs %6.1f\n",
+               quantiles[q] * 100,
+               GREEN,
+               *(int *)quantile_sketch_query(sketches[0], quantiles[q]) / 10.0,
+               RESET,
+               *(int *)citerator_peek(citer) / 10.0);
+        q++;
+    }
+    citerator_destroy(citer);
+    printf("\n");
+    print_tag(stdout,
+              NOTE,
+              "`%stop_k_merge%s` and `%squantile_sketch_merge%s` combine partial\n"
+              "results, so each thread/shard can consume its own CIterator. For a\n"
+              "single CIterator, `%sciterator_top_k%s` does it all in one call.\n",
+              CYAN,
+              RESET,
+              CYAN,
+              RESET,
+              CYAN,
+              RESET);
+    for (size_t s = 0; s < 2; s++) {
+        top_k_destroy(tops[s]);
+        quantile_sketch_destroy(sketches[s]);
+        free(shards[s]);
+    }
+    free(latencies);
+}
+
+void part8(void) {
+    enum { ID, QTY, PRICE, WEIGHT };
+    Record *records = (Record *)calloc(BENCH_LEN, sizeof(Record));
+    CTable *table = ctable_new(BENCH_LEN);
+    int columns_ok = ctable_add_column(table, sizeof(int), 0) &&
+                     ctable_add_column(table, sizeof(int), 0) &&
+                     ctable_add_column(table, sizeof(float), 1) &&
+                     ctable_add_column(table, sizeof(float), 0);
+    if (!records || !columns_ok) {
+        free(records);
+        ctable_destroy(table);
+        return;
+    }
+    srand(42);
+    for (size_t i = 0; i < BENCH_LEN; i++) {
+        records[i].id = (int)i;
+        records[i].qty = rand() % 10;
+        records[i].price = (float)(rand() % 10000) / 100.0f;
+        records[i].weight = (float)(rand() % 100);
+        ctable_set(table, i, ID, &records[i].id);
+        ctable_set(table, i, QTY, &records[i].qty);
+        // every 4th price is unknown (null)
+        if (i % 4 != 1)
+            ctable_set(table, i, PRICE, &records[i].price);
+        ctable_set(table, i, WEIGHT, &records[i].weight);
+    }
+    printf("A %sCTable%s stores each record field in its own array (%scolumn%s).\n",
+           CYAN,
+           RESET,
+           GREEN,
+           RESET);
+    printf("Projecting the (%sid%s, %sprice%s) columns, each item is a %svoid **%s\n",
+           YELLOW,
+           RESET,
+           YELLOW,
+           RESET,
+           CYAN,
+           RESET);
+    printf("with one pointer per column (%sNULL%s for null values):\n\n", RED, RESET);
+    CIterator *citer = new_citerator_from_ctable_projection(table, (size_t[]){ ID, PRICE }, 2);
+    for (; citer && citerator_get_index(citer) < 4; citerator_go_next(citer)) {
+        void **row = (void **)citerator_peek(citer);
+        printf("  [%s%d%s: ", GREEN, *(int *)row[0], RESET);
+        if (row[1])
+            printf("%.2f]\n", *(float *)row[1]);
+        else
+            printf("%snull%s]\n", RED, RESET);
+    }
+    citerator_destroy(citer);
+    double row_sum = 0.0, column_sum = 0.0;
+    clock_t start = clock();
+    for (size_t i = 0; i < BENCH_LEN; i++)
+        row_sum += records[i].weight;
+    double row_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    size_t len;
+    start = clock();
+    float *weights = (float *)ctable_column_slice(table, WEIGHT, 0, &len);
+    for (size_t i = 0; i < len; i++)
+        column_sum += weights[i];
+    double column_secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("\nSumming the %sweight%s field of %d records:\n", YELLOW, RESET, BENCH_LEN);
+    printf("  records (%zu bytes read): %s%.4fs%s\n",
+           BENCH_LEN * sizeof(Record),
+           RED,
+           row_secs,
+           RESET);
+    printf("  `%sctable_column_slice%s` (%zu bytes read): %s%.4fs%s\n",
+           CYAN,
+           RESET,
+           len * sizeof(float),
+           GREEN,
+           column_secs,
+           RESET);
+    printf("  (same result: %s%s%s)\n\n",
+           row_sum == column_sum ? GREEN : RED,
+           row_sum == column_sum ? "yes" : "no",
+           RESET);
+    print_tag(stdout,
+              NOTE,
+              "the projected rows live in the CIterator buffer, so they're\n"
+              "only valid until the iteration leaves its chunk (%d rows)!\n",
+              CTABLE_CHUNK_LEN);
+    ctable_destroy(table);
+    free(records);
+}
+
 int float_comp(float *self, float *other) {
     if (!self || !other)
         return 0;
@@ -329,4 +666,10 @@ int float_comp(float *self, float *other) {
         return 0;
 }
 
+int int_comp(int *self, int *other) {
+    if (!self || !other)
+        return 0;
+    return *self < *other ? -1 : *self > *other;
+}
+
 void ghost_free(void) {}
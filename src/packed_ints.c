@@ -0,0 +1,211 @@
+#include "packed_ints.h"
+#include <string.h>
+
+/* Note: a PackedInts splits the posints into blocks of `PACKED_INTS_BLOCK_LEN` ints. Each block
+ * keeps its first int and the deltas between neighbour ints, shifted by the block smallest delta
+ * (so unsorted sequences also work) and packed with the smallest bit width that fits them all.
+ * Sorted IDs usually need just a few bits per int instead of the 12 bytes (int + queue pointer)
+ * used by `push_posints_into_citerator`. */
+
+/* State of the CIterator lazy source. */
+typedef struct {
+    /* The container being iterated (not owned). */
+    PackedInts *packed;
+    /* The next block to be decoded. */
+    size_t next_block;
+    /* Reusable decode buffer (the CIterator queue points to it). */
+    int values[PACKED_INTS_BLOCK_LEN];
+} PackedIntsSource;
+
+uint32_t bit_width_of(uint32_t);
+void pack_block(uint32_t *, uint32_t *, size_t, uint32_t);
+void unpack_block(uint32_t *, uint32_t *, size_t, uint32_t);
+int refill_packed_ints(CIterator *, int);
+
+/* Creates a new PackedInts from a posints. Don't forget the negative int safeguard. */
+PackedInts *packed_ints_new(int *posints) {
+    if (!posints)
+        return NULL;
+    size_t len;
+    for (len = 0; posints[len] >= 0; len++)
+        ;
+    size_t block_count = (len + PACKED_INTS_BLOCK_LEN - 1) / PACKED_INTS_BLOCK_LEN;
+    PackedInts *packed = (PackedInts *)malloc(sizeof(PackedInts));
+    PackedBlock *blocks = (PackedBlock *)malloc((block_count + 1) * sizeof(PackedBlock));
+    // worst case size (32 bits per delta), shrunk once every block is packed
+    uint32_t *words = (uint32_t *)calloc(len + 1, sizeof(uint32_t));
+    if (!packed || !blocks || !words) {
+        free(packed);
+        free(blocks);
+        free(words);
+        return NULL;
+    }
+    uint32_t deltas[PACKED_INTS_BLOCK_LEN];
+    size_t word_count = 0;
+    for (size_t b = 0; b < block_count; b++) {
+        int *values = &posints[b * PACKED_INTS_BLOCK_LEN];
+        size_t count = len - b * PACKED_INTS_BLOCK_LEN;
+        if (count > PACKED_INTS_BLOCK_LEN)
+            count = PACKED_INTS_BLOCK_LEN;
+        int min_delta = 0;
+        for (size_t i = 1; i < count; i++) {
+            int delta = values[i] - values[i - 1];
+            if (i == 1 || delta < min_delta)
+                min_delta = delta;
+        }
+        uint32_t max_shifted = 0;
+        for (size_t i = 1; i < count; i++) {
+            deltas[i - 1] = (uint32_t)(values[i] - values[i - 1]) - (uint32_t)min_delta;
+            if (deltas[i - 1] > max_shifted)
+                max_shifted = deltas[i - 1];
+        }
+        uint32_t bit_width = bit_width_of(max_shifted);
+        blocks[b].first = values[0];
+        blocks[b].min_delta = min_delta;
+        blocks[b].bit_width = bit_width;
+        blocks[b].offset = word_count;
+        pack_block(&words[word_count], deltas, count - 1, bit_width);
+        word_count += ((count - 1) * bit_width + 31) / 32;
+    }
+    // one extra (zeroed) word lets the unpacking always read two words at once
+    uint32_t *shrunk = (uint32_t *)realloc(words, (word_count + 1) * sizeof(uint32_t));
+    if (shrunk)
+        words = shrunk;
+    packed->len = len;
+    packed->block_count = block_count;
+    packed->blocks = blocks;
+    packed->words = words;
+    packed->word_count = word_count;
+    return packed;
+}
+
+/* Returns the amount of ints held by the PackedInts. */
+size_t packed_ints_len(PackedInts *self) { return self ? self->len : 0; }
+
+/* Returns the amount of bytes used by the PackedInts (headers included). */
+size_t packed_ints_size(PackedInts *self) {
+    if (!self)
+        return 0;
+    return sizeof(PackedInts) + self->block_count * sizeof(PackedBlock) +
+           (self->word_count + 1) * sizeof(uint32_t);
+}
+
+/* Decodes the block at the given index into `out` (which must have room for
+ * `PACKED_INTS_BLOCK_LEN` ints) and returns the amount of decoded ints (0 if the block doesn't
+ * exist). Useful for batch processing without a CIterator. */
+size_t packed_ints_decode_block(PackedInts *self, size_t block, int *out) {
+    if (!self || !out || block >= self->block_count)
+        return 0;
+    PackedBlock *header = &self->blocks[block];
+    size_t count = self->len - block * PACKED_INTS_BLOCK_LEN;
+    if (count > PACKED_INTS_BLOCK_LEN)
+        count = PACKED_INTS_BLOCK_LEN;
+    uint32_t deltas[PACKED_INTS_BLOCK_LEN];
+    unpack_block(&self->words[header->offset], deltas, count - 1, header->bit_width);
+    // unsigned math wraps just like the encoding did
+    uint32_t value = (uint32_t)header->first, min_delta = (uint32_t)header->min_delta;
+    out[0] = header->first;
+    for (size_t i = 1; i < count; i++) {
+        value += deltas[i - 1] + min_delta;
+        out[i] = (int)value;
+    }
+    return count;
+}
+
+/* Destroy the PackedInts + return a NULL pointer. */
+PackedInts *packed_ints_destroy(PackedInts *self) {
+    if (!self)
+        return NULL;
+    free(self->blocks);
+    free(self->words);
+    free(self);
+    return NULL;
+}
+
+/* Push a PackedInts into a CIterator. The ints are decoded one block at a time into a buffer owned
+ * by the CIterator, so a peeked pointer is only valid until the iteration leaves its block. The
+ * PackedInts must outlive the CIterator. */
+void push_packed_ints_into_citerator(CIterator *citerator, PackedInts *packed) {
+    if (!citerator || !packed)
+        return;
+    citerator_clear(citerator);
+    if (packed->len == 0)
+        return;
+    PackedIntsSource *source = (PackedIntsSource *)malloc(sizeof(PackedIntsSource));
+    int **ints = (int **)malloc(PACKED_INTS_BLOCK_LEN * sizeof(int *));
+    if (!source || !ints) {
+        free(source);
+        free(ints);
+        return;
+    }
+    source->packed = packed;
+    source->next_block = 0;
+    // the queue addresses never change, only the values behind them
+    for (size_t i = 0; i < PACKED_INTS_BLOCK_LEN; i++)
+        ints[i] = &source->values[i];
+    citerator->root_pointer = (void **)ints;
+    citerator->source = source;
+    citerator->refill = refill_packed_ints;
+    citerator->source_free = free;
+    refill_packed_ints(citerator, 1);
+    citerator->current = citerator->root_pointer[0];
+    citerator->is_done = 0;
+}
+
+/* Creates a new CIterator from a PackedInts. */
+CIterator *new_citerator_from_packed_ints(PackedInts *packed) {
+    CIterator *citerator = citerator_new();
+    if (citerator)
+        push_packed_ints_into_citerator(citerator, packed);
+    return citerator;
+}
+
+/* Private function that returns the amount of bits required to represent the value. */
+uint32_t bit_width_of(uint32_t value) {
+    uint32_t width = 0;
+    for (; value; value >>= 1)
+        width++;
+    return width;
+}
+
+/* Private function that packs `count` values using `bit_width` bits each (the words must be
+ * zeroed). */
+void pack_block(uint32_t *words, uint32_t *values, size_t count, uint32_t bit_width) {
+    if (bit_width == 0)
+        return;
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * bit_width;
+        uint32_t shift = (uint32_t)(bit & 31);
+        words[bit >> 5] |= values[i] << shift;
+        if (shift + bit_width > 32)
+            words[(bit >> 5) + 1] |= values[i] >> (32 - shift);
+    }
+}
+
+/* Private function that unpacks `count` values of `bit_width` bits each. Every value is read from
+ * a pair of neighbour words (hence the padding word), so there's no branch on word boundaries. */
+void unpack_block(uint32_t *words, uint32_t *values, size_t count, uint32_t bit_width) {
+    if (bit_width == 0) {
+        memset(values, 0, count * sizeof(uint32_t));
+        return;
+    }
+    uint64_t mask = ((uint64_t)1 << bit_width) - 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t bit = i * bit_width;
+        uint64_t pair = (uint64_t)words[bit >> 5] | (uint64_t)words[(bit >> 5) + 1] << 32;
+        values[i] = (uint32_t)((pair >> (bit & 31)) & mask);
+    }
+}
+
+/* Private CIterator refill function: decodes the next block into the source buffer. */
+int refill_packed_ints(CIterator *citer, int restart) {
+    PackedIntsSource *source = (PackedIntsSource *)citer->source;
+    if (restart)
+        source->next_block = 0;
+    size_t count = packed_ints_decode_block(source->packed, source->next_block, source->values);
+    if (count == 0)
+        return 0;
+    source->next_block++;
+    citer->queue_len = count;
+    return 1;
+}
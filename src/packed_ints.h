@@ -0,0 +1,44 @@
+#ifndef _PACKED_INTS_H_
+#define _PACKED_INTS_H_
+
+#include "citer.h"
+#include <stdint.h>
+
+/* Amount of ints held by a single PackedInts block. */
+#define PACKED_INTS_BLOCK_LEN 128
+
+/* Header of a PackedInts block. */
+typedef struct {
+    /* The first int of the block (stored as is). */
+    int first;
+    /* The smallest delta between two neighbour ints within the block. */
+    int min_delta;
+    /* Bit width of each packed delta (delta - `min_delta`). */
+    uint32_t bit_width;
+    /* Offset of the packed deltas on the words array. */
+    size_t offset;
+} PackedBlock;
+
+/* A compressed (block based delta + bit packing) posints container. */
+typedef struct {
+    /* The amount of packed ints. */
+    size_t len;
+    /* The amount of blocks (`len` / `PACKED_INTS_BLOCK_LEN` rounded up). */
+    size_t block_count;
+    /* Block headers. */
+    PackedBlock *blocks;
+    /* The packed deltas of all blocks. */
+    uint32_t *words;
+    /* The amount of words (not including the trailing padding word). */
+    size_t word_count;
+} PackedInts;
+
+PackedInts *packed_ints_new(int *);
+size_t packed_ints_len(PackedInts *);
+size_t packed_ints_size(PackedInts *);
+size_t packed_ints_decode_block(PackedInts *, size_t, int *);
+PackedInts *packed_ints_destroy(PackedInts *);
+void push_packed_ints_into_citerator(CIterator *, PackedInts *);
+CIterator *new_citerator_from_packed_ints(PackedInts *);
+
+#endif
@@ -0,0 +1,247 @@
+#include "quantile.h"
+#include <string.h>
+
+/* Note: the sketch is a KLL one. Items are pushed into level 0 and, when the sketch holds more
+ * items than its capacity, the lowest full level is sorted and every other item (odd or even
+ * positions, randomly) is promoted to the next level with twice the weight. This keeps
+ * O(k log(n / k)) items with a rank error around O(1 / k), regardless of the stream length. The
+ * items are copied (`elem_size` bytes each), so the sketch works with any CIterator, even the ones
+ * whose peeked pointers are invalidated when the iteration moves on (lazy sources). */
+
+/* An item + its weight (used when answering queries). */
+typedef struct {
+    void *data;
+    size_t weight;
+} WeightedItem;
+
+size_t level_capacity(QuantileSketch *, size_t);
+int level_append(SketchLevel *, void *, size_t);
+int add_level(QuantileSketch *);
+void compress(QuantileSketch *);
+void sort_elements(void *, size_t, size_t, int (*)(void *, void *), int);
+
+/* Creates a new QuantileSketch over items of `elem_size` bytes + a comparer function. The `k`
+ * parameter trades memory for accuracy (200 is a good default, values below 8 are raised to 8). */
+QuantileSketch *quantile_sketch_new(size_t k, size_t elem_size, int (*comparer)(void *, void *)) {
+    if (!comparer || elem_size == 0)
+        return NULL;
+    QuantileSketch *sketch = (QuantileSketch *)malloc(sizeof(QuantileSketch));
+    if (!sketch)
+        return NULL;
+    sketch->levels = NULL;
+    sketch->level_count = 0;
+    sketch->k = k < 8 ? 8 : k;
+    sketch->elem_size = elem_size;
+    sketch->count = 0;
+    sketch->comp = comparer;
+    sketch->seed = 0x9e3779b97f4a7c15u;
+    if (!add_level(sketch)) {
+        free(sketch);
+        return NULL;
+    }
+    return sketch;
+}
+
+/* Insert a copy of the item into the sketch. */
+void quantile_sketch_push(QuantileSketch *self, void *data) {
+    if (!self || !data)
+        return;
+    if (!level_append(&self->levels[0], data, self->elem_size))
+        return;
+    self->count++;
+    compress(self);
+}
+
+/* Insert every remaining item of the CIterator into the sketch (single pass). The CIterator ends
+ * up done, but its queue isn't cleaned. */
+void quantile_sketch_consume(QuantileSketch *self, CIterator *citer) {
+    if (!self)
+        return;
+    for (; !citerator_is_done(citer); citerator_go_next(citer))
+        quantile_sketch_push(self, citerator_peek(citer));
+}
+
+/* Merge the `other` sketch items into `self`, allowing sketches built by different threads/shards
+ * to be combined. Both sketches must use the same comparer and item size. The `other` sketch isn't
+ * changed. */
+void quantile_sketch_merge(QuantileSketch *self, QuantileSketch *other) {
+    if (!self || !other || self == other || self->elem_size != other->elem_size)
+        return;
+    for (size_t h = 0; h < other->level_count; h++) {
+        if (h >= self->level_count && !add_level(self))
+            return;
+        SketchLevel *level = &other->levels[h];
+        size_t size = other->elem_size;
+        for (size_t i = 0; i < level->len; i++)
+            if (!level_append(&self->levels[h], level->items + i * size, size))
+                return;
+    }
+    self->count += other->count;
+    compress(self);
+}
+
+/* Returns the amount of items pushed into the sketch (merged ones included). */
+size_t quantile_sketch_count(QuantileSketch *self) { return self ? self->count : 0; }
+
+/* Returns the (approximate) item at the given quantile (0.0 is the smallest item, 1.0 is the
+ * largest one) or NULL if the sketch is empty. The returned pointer is a sketch copy, valid until
+ * the sketch is changed (push/merge) or destroyed. */
+void *quantile_sketch_query(QuantileSketch *self, double quantile) {
+    if (!self || self->count == 0)
+        return NULL;
+    size_t len = 0;
+    for (size_t h = 0; h < self->level_count; h++)
+        len += self->levels[h].len;
+    WeightedItem *items = (WeightedItem *)malloc(len * sizeof(WeightedItem));
+    if (!items)
+        return NULL;
+    size_t ind = 0, total = 0;
+    for (size_t h = 0; h < self->level_count; h++) {
+        for (size_t i = 0; i < self->levels[h].len; i++) {
+            items[ind].data = self->levels[h].items + i * self->elem_size;
+            items[ind++].weight = (size_t)1 << h;
+        }
+        total += self->levels[h].len << h;
+    }
+    sort_elements(items, len, sizeof(WeightedItem), self->comp, 1);
+    if (quantile < 0.0)
+        quantile = 0.0;
+    else if (quantile > 1.0)
+        quantile = 1.0;
+    double target = quantile * (double)total;
+    size_t seen = 0;
+    void *data = items[len - 1].data;
+    for (size_t i = 0; i < len; i++) {
+        seen += items[i].weight;
+        if ((double)seen >= target) {
+            data = items[i].data;
+            break;
+        }
+    }
+    free(items);
+    return data;
+}
+
+/* Destroy the sketch (and the item copies) + return a NULL pointer. */
+QuantileSketch *quantile_sketch_destroy(QuantileSketch *self) {
+    if (!self)
+        return NULL;
+    for (size_t h = 0; h < self->level_count; h++)
+        free(self->levels[h].items);
+    free(self->levels);
+    free(self);
+    return NULL;
+}
+
+/* Private function that returns the capacity of the given level: `k` for the top level, shrinking
+ * by 2/3 for each level below it (never less than 2). */
+size_t level_capacity(QuantileSketch *self, size_t level) {
+    size_t capacity = self->k;
+    for (size_t depth = self->level_count - 1 - level; depth > 0 && capacity > 2; depth--)
+        capacity = capacity * 2 / 3;
+    return capacity < 2 ? 2 : capacity;
+}
+
+/* Private function that appends a copy of the item into the level (growing it if needed). */
+int level_append(SketchLevel *level, void *data, size_t elem_size) {
+    if (level->len == level->room) {
+        size_t room = level->room ? level->room * 2 : 8;
+        char *items = (char *)realloc(level->items, room * elem_size);
+        if (!items)
+            return 0;
+        level->items = items;
+        level->room = room;
+    }
+    memcpy(level->items + level->len++ * elem_size, data, elem_size);
+    return 1;
+}
+
+/* Private function that adds a new (empty) top level. */
+int add_level(QuantileSketch *self) {
+    SketchLevel *levels =
+        (SketchLevel *)realloc(self->levels, (self->level_count + 1) * sizeof(SketchLevel));
+    if (!levels)
+        return 0;
+    levels[self->level_count].items = NULL;
+    levels[self->level_count].len = 0;
+    levels[self->level_count].room = 0;
+    self->levels = levels;
+    self->level_count++;
+    return 1;
+}
+
+/* Private function that compacts the lowest full levels until the sketch fits its capacity. */
+void compress(QuantileSketch *self) {
+    for (;;) {
+        size_t len = 0, capacity = 0;
+        for (size_t h = 0; h < self->level_count; h++) {
+            len += self->levels[h].len;
+            capacity += level_capacity(self, h);
+        }
+        if (len < capacity)
+            return;
+        size_t h;
+        for (h = 0; h < self->level_count; h++)
+            if (self->levels[h].len >= level_capacity(self, h))
+                break;
+        if (h == self->level_count)
+            return;
+        if (h + 1 == self->level_count && !add_level(self))
+            return;
+        SketchLevel *level = &self->levels[h];
+        size_t size = self->elem_size;
+        sort_elements(level->items, level->len, size, self->comp, 0);
+        // xorshift64: a random bit decides which half survives (keeps the sketch unbiased)
+        self->seed ^= self->seed << 13;
+        self->seed ^= self->seed >> 7;
+        self->seed ^= self->seed << 17;
+        size_t offset = (size_t)(self->seed & 1);
+        // an odd item out stays on the current level
+        size_t pairs = level->len / 2 * 2;
+        for (size_t i = offset; i < pairs; i += 2)
+            if (!level_append(&self->levels[h + 1], level->items + i * size, size))
+                return;
+        if (level->len > pairs)
+            memcpy(level->items, level->items + pairs * size, size);
+        level->len -= pairs;
+    }
+}
+
+/* Private (stable, bottom-up merge) sort over an array of elements of `size` bytes. The comparer
+ * gets the elements themselves or, when `deref` is set, the `void *` data held by their first
+ * member. */
+void sort_elements(void *base, size_t len, size_t size, int (*comp)(void *, void *), int deref) {
+    if (len < 2)
+        return;
+    char *from = (char *)base, *to = (char *)malloc(len * size);
+    if (!to)
+        return;
+    char *scratch = to;
+    for (size_t width = 1; width < len; width *= 2) {
+        for (size_t lo = 0; lo < len; lo += 2 * width) {
+            size_t mid = lo + width < len ? lo + width : len;
+            size_t hi = lo + 2 * width < len ? lo + 2 * width : len;
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                void *a = from + i * size, *b = from + j * size;
+                if (deref) {
+                    a = *(void **)a;
+                    b = *(void **)b;
+                }
+                if (comp(a, b) <= 0)
+                    memcpy(to + k++ * size, from + i++ * size, size);
+                else
+                    memcpy(to + k++ * size, from + j++ * size, size);
+            }
+            memcpy(to + k * size, from + i * size, (mid - i) * size);
+            k += mid - i;
+            memcpy(to + k * size, from + j * size, (hi - j) * size);
+        }
+        char *tmp = from;
+        from = to;
+        to = tmp;
+    }
+    if (from != (char *)base)
+        memcpy(base, from, len * size);
+    free(scratch);
+}
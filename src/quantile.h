@@ -0,0 +1,44 @@
+#ifndef _QUANTILE_H_
+#define _QUANTILE_H_
+
+#include "citer.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* A QuantileSketch level (items on level `h` weight 2^h). */
+typedef struct {
+    /* The item copies (not sorted, `elem_size` bytes each). */
+    char *items;
+    /* The amount of items on the level. */
+    size_t len;
+    /* The allocated room of `items`. */
+    size_t room;
+} SketchLevel;
+
+/* Approximate quantile sketch (KLL) over generic items. */
+typedef struct {
+    /* The levels (compactors), from the lowest weight to the highest one. */
+    SketchLevel *levels;
+    /* The amount of levels. */
+    size_t level_count;
+    /* Accuracy parameter: capacity of the top level (the lower ones get smaller). */
+    size_t k;
+    /* The size of a single item. */
+    size_t elem_size;
+    /* The amount of items pushed into the sketch. */
+    size_t count;
+    /* Comparer function (assert eq between value $0 and $1). */
+    int (*comp)(void *, void *);
+    /* Random state used to choose which half of a level survives compaction. */
+    uint64_t seed;
+} QuantileSketch;
+
+QuantileSketch *quantile_sketch_new(size_t, size_t, int (*)(void *, void *));
+void quantile_sketch_push(QuantileSketch *, void *);
+void quantile_sketch_consume(QuantileSketch *, CIterator *);
+void quantile_sketch_merge(QuantileSketch *, QuantileSketch *);
+size_t quantile_sketch_count(QuantileSketch *);
+void *quantile_sketch_query(QuantileSketch *, double);
+QuantileSketch *quantile_sketch_destroy(QuantileSketch *);
+
+#endif
@@ -0,0 +1,156 @@
+#include "radix.h"
+#include <string.h>
+
+/* Note: the sorted views don't copy nor reorder the source array. The CIterator queue holds
+ * pointers into the source, sorted by value (ascending) through a LSD radix sort, so no BTree (and
+ * no comparer function) is required to iterate numeric data in order. */
+
+/* A sort key + the source address it comes from. */
+typedef struct {
+    uint64_t key;
+    void *data;
+} RadixItem;
+
+void radix_sort(RadixItem *, RadixItem *, size_t, size_t);
+void push_radix_items_into_citerator(CIterator *, RadixItem *, RadixItem *, size_t, size_t);
+uint32_t float_to_sortable(float);
+
+/* Push a sequence of positive integers into a CIterator sorted by value. Just like
+ * `push_posints_into_citerator`, the posints array must contain a negative integer as safeguard. */
+void push_sorted_posints_into_citerator(CIterator *citerator, int *posints) {
+    if (!citerator || !posints)
+        return;
+    citerator_clear(citerator);
+    size_t len;
+    for (len = 0; posints[len] >= 0; len++)
+        ;
+    if (len == 0)
+        return;
+    RadixItem *items = (RadixItem *)malloc(2 * len * sizeof(RadixItem));
+    if (!items)
+        return;
+    for (size_t i = 0; i < len; i++) {
+        items[i].key = (uint64_t)posints[i];
+        items[i].data = &posints[i];
+    }
+    push_radix_items_into_citerator(citerator, items, items + len, len, sizeof(int));
+    free(items);
+}
+
+/* Push `len` floats into a CIterator sorted by value. NaNs are placed after `+inf` (or before
+ * `-inf` when the sign bit is set). */
+void push_sorted_floats_into_citerator(CIterator *citerator, float *floats, size_t len) {
+    if (!citerator || !floats)
+        return;
+    citerator_clear(citerator);
+    if (len == 0)
+        return;
+    RadixItem *items = (RadixItem *)malloc(2 * len * sizeof(RadixItem));
+    if (!items)
+        return;
+    for (size_t i = 0; i < len; i++) {
+        items[i].key = float_to_sortable(floats[i]);
+        items[i].data = &floats[i];
+    }
+    push_radix_items_into_citerator(citerator, items, items + len, len, sizeof(float));
+    free(items);
+}
+
+/* Push `len` unsigned 64 bit integers into a CIterator sorted by value. */
+void push_sorted_u64s_into_citerator(CIterator *citerator, uint64_t *u64s, size_t len) {
+    if (!citerator || !u64s)
+        return;
+    citerator_clear(citerator);
+    if (len == 0)
+        return;
+    RadixItem *items = (RadixItem *)malloc(2 * len * sizeof(RadixItem));
+    if (!items)
+        return;
+    for (size_t i = 0; i < len; i++) {
+        items[i].key = u64s[i];
+        items[i].data = &u64s[i];
+    }
+    push_radix_items_into_citerator(citerator, items, items + len, len, sizeof(uint64_t));
+    free(items);
+}
+
+/* Creates a new sorted CIterator from a posints. Don't forget the negative int safeguard. */
+CIterator *new_citerator_sorted_from_posints(int *posints) {
+    CIterator *citerator = citerator_new();
+    if (citerator)
+        push_sorted_posints_into_citerator(citerator, posints);
+    return citerator;
+}
+
+/* Creates a new sorted CIterator from a float array. */
+CIterator *new_citerator_sorted_from_floats(float *floats, size_t len) {
+    CIterator *citerator = citerator_new();
+    if (citerator)
+        push_sorted_floats_into_citerator(citerator, floats, len);
+    return citerator;
+}
+
+/* Creates a new sorted CIterator from an uint64_t array. */
+CIterator *new_citerator_sorted_from_u64s(uint64_t *u64s, size_t len) {
+    CIterator *citerator = citerator_new();
+    if (citerator)
+        push_sorted_u64s_into_citerator(citerator, u64s, len);
+    return citerator;
+}
+
+/* Private function that sorts the items (using `scratch` as the swap buffer) and moves the
+ * sorted addresses into the CIterator queue. */
+void push_radix_items_into_citerator(
+    CIterator *citer, RadixItem *items, RadixItem *scratch, size_t len, size_t key_bytes) {
+    void **queue = (void **)malloc(len * sizeof(void *));
+    if (!queue)
+        return;
+    radix_sort(items, scratch, len, key_bytes);
+    for (size_t i = 0; i < len; i++)
+        queue[i] = items[i].data;
+    citer->queue_len = len;
+    citer->root_pointer = queue;
+    citer->current = citer->root_pointer[0];
+    citer->is_done = 0;
+}
+
+/* Private LSD radix sort (one byte per pass) over the lowest `key_bytes` bytes of the item keys.
+ * All the byte histograms are built in a single read and passes where every key shares the same
+ * byte are skipped. The result always ends up in `items`. */
+void radix_sort(RadixItem *items, RadixItem *scratch, size_t len, size_t key_bytes) {
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < len; i++) {
+        uint64_t key = items[i].key;
+        for (size_t b = 0; b < key_bytes; b++)
+            counts[b][(key >> (b * 8)) & 0xff]++;
+    }
+    RadixItem *from = items, *to = scratch;
+    for (size_t b = 0; b < key_bytes; b++) {
+        size_t *count = counts[b];
+        // every key has the same byte here, so the pass wouldn't move anything
+        if (count[(from[0].key >> (b * 8)) & 0xff] == len)
+            continue;
+        size_t offset = 0;
+        for (size_t d = 0; d < 256; d++) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < len; i++)
+            to[count[(from[i].key >> (b * 8)) & 0xff]++] = from[i];
+        RadixItem *tmp = from;
+        from = to;
+        to = tmp;
+    }
+    if (from != items)
+        memcpy(items, from, len * sizeof(RadixItem));
+}
+
+/* Private function that maps the float bits to an unsigned integer with the same ordering:
+ * negative floats get all bits flipped while positive ones only get the sign bit set. */
+uint32_t float_to_sortable(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
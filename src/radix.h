@@ -0,0 +1,14 @@
+#ifndef _RADIX_H_
+#define _RADIX_H_
+
+#include "citer.h"
+#include <stdint.h>
+
+void push_sorted_posints_into_citerator(CIterator *, int *);
+void push_sorted_floats_into_citerator(CIterator *, float *, size_t);
+void push_sorted_u64s_into_citerator(CIterator *, uint64_t *, size_t);
+CIterator *new_citerator_sorted_from_posints(int *);
+CIterator *new_citerator_sorted_from_floats(float *, size_t);
+CIterator *new_citerator_sorted_from_u64s(uint64_t *, size_t);
+
+#endif
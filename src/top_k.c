@@ -0,0 +1,158 @@
+#include "top_k.h"
+#include <string.h>
+
+/* Note: the TopK copies the items it keeps (`elem_size` bytes each), so it works with any
+ * CIterator, even the ones whose peeked pointers are invalidated when the iteration moves on (lazy
+ * sources). */
+
+void heap_sift_up(void **, size_t, int (*)(void *, void *));
+void heap_sift_down(void **, size_t, size_t, int (*)(void *, void *));
+void top_k_source_free(void *);
+
+/* Creates a new TopK that keeps a copy of the `k` largest items (of `elem_size` bytes) based on
+ * the comparer function. */
+TopK *top_k_new(size_t k, size_t elem_size, int (*comparer)(void *, void *)) {
+    if (!comparer || elem_size == 0)
+        return NULL;
+    TopK *top = (TopK *)malloc(sizeof(TopK));
+    if (!top)
+        return NULL;
+    top->heap = (void **)malloc((k ? k : 1) * sizeof(void *));
+    top->values = (char *)malloc((k ? k : 1) * elem_size);
+    if (!top->heap || !top->values) {
+        free(top->heap);
+        free(top->values);
+        free(top);
+        return NULL;
+    }
+    top->len = 0;
+    top->k = k;
+    top->elem_size = elem_size;
+    top->comp = comparer;
+    return top;
+}
+
+/* Offers a new item to the TopK. The item is copied if it's one of the `k` largest so far. */
+void top_k_push(TopK *self, void *data) {
+    if (!self || !data || self->k == 0)
+        return;
+    if (self->len < self->k) {
+        void *slot = self->values + self->len * self->elem_size;
+        memcpy(slot, data, self->elem_size);
+        self->heap[self->len] = slot;
+        heap_sift_up(self->heap, self->len++, self->comp);
+    } else if (self->comp(data, self->heap[0]) > 0) {
+        // the smallest kept item is overwritten, its slot is reused
+        memcpy(self->heap[0], data, self->elem_size);
+        heap_sift_down(self->heap, self->len, 0, self->comp);
+    }
+}
+
+/* Offers every remaining item of the CIterator to the TopK (single pass). The CIterator ends up
+ * done, but its queue isn't cleaned. */
+void top_k_consume(TopK *self, CIterator *citer) {
+    if (!self)
+        return;
+    for (; !citerator_is_done(citer); citerator_go_next(citer))
+        top_k_push(self, citerator_peek(citer));
+}
+
+/* Offers the `other` TopK items to `self`, allowing partial results (threads, shards, ...) to be
+ * combined. Both TopK must hold items of the same size. The `other` TopK isn't changed. */
+void top_k_merge(TopK *self, TopK *other) {
+    if (!self || !other || self == other || self->elem_size != other->elem_size)
+        return;
+    for (size_t i = 0; i < other->len; i++)
+        top_k_push(self, other->heap[i]);
+}
+
+/* Destroy the TopK (and the kept copies) + return a NULL pointer. */
+TopK *top_k_destroy(TopK *self) {
+    if (!self)
+        return NULL;
+    free(self->heap);
+    free(self->values);
+    free(self);
+    return NULL;
+}
+
+/* Push the TopK items into the provided CIterator pointer (largest first). The CIterator points to
+ * the TopK copies, so they're only valid while the TopK lives and isn't pushed new items. */
+void push_top_k_into_citerator(CIterator *citer, TopK *top) {
+    if (!citer || !top)
+        return;
+    citerator_clear(citer);
+    size_t len = top->len;
+    if (len == 0)
+        return;
+    void **datas = (void **)malloc(len * sizeof(void *));
+    if (!datas)
+        return;
+    memcpy(datas, top->heap, len * sizeof(void *));
+    // heap sort over the copy: moving the min-heap root to the end sorts it largest first
+    for (size_t end = len - 1; end > 0; end--) {
+        void *tmp = datas[0];
+        datas[0] = datas[end];
+        datas[end] = tmp;
+        heap_sift_down(datas, end, 0, top->comp);
+    }
+    citer->queue_len = len;
+    citer->root_pointer = datas;
+    citer->current = citer->root_pointer[0];
+    citer->is_done = 0;
+}
+
+/* Creates a new CIterator with a copy of the `k` largest (largest first) remaining items of
+ * `citer`, using O(k) memory instead of a whole BTree. The copies are owned (and freed) by the
+ * returned CIterator. */
+CIterator *citerator_top_k(CIterator *citer,
+                           size_t k,
+                           size_t elem_size,
+                           int (*comparer)(void *, void *)) {
+    TopK *top = top_k_new(k, elem_size, comparer);
+    if (!top)
+        return NULL;
+    top_k_consume(top, citer);
+    CIterator *result = citerator_new();
+    if (!result) {
+        top_k_destroy(top);
+        return NULL;
+    }
+    push_top_k_into_citerator(result, top);
+    result->source = top;
+    result->source_free = top_k_source_free;
+    return result;
+}
+
+/* Private function that moves the heap item at `ind` up to its place. */
+void heap_sift_up(void **heap, size_t ind, int (*comp)(void *, void *)) {
+    while (ind > 0) {
+        size_t parent = (ind - 1) / 2;
+        if (comp(heap[parent], heap[ind]) <= 0)
+            break;
+        void *tmp = heap[parent];
+        heap[parent] = heap[ind];
+        heap[ind] = tmp;
+        ind = parent;
+    }
+}
+
+/* Private function that moves the heap (of `len` items) item at `ind` down to its place. */
+void heap_sift_down(void **heap, size_t len, size_t ind, int (*comp)(void *, void *)) {
+    for (;;) {
+        size_t smallest = ind, left = 2 * ind + 1, right = left + 1;
+        if (left < len && comp(heap[left], heap[smallest]) < 0)
+            smallest = left;
+        if (right < len && comp(heap[right], heap[smallest]) < 0)
+            smallest = right;
+        if (smallest == ind)
+            return;
+        void *tmp = heap[smallest];
+        heap[smallest] = heap[ind];
+        heap[ind] = tmp;
+        ind = smallest;
+    }
+}
+
+/* Private function that frees a TopK owned by a CIterator. */
+void top_k_source_free(void *data) { top_k_destroy((TopK *)data); }
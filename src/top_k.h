@@ -0,0 +1,31 @@
+#ifndef _TOP_K_H_
+#define _TOP_K_H_
+
+#include "citer.h"
+#include <stdlib.h>
+
+/* Type that keeps a copy of the `k` largest items seen so far (bounded min-heap). */
+typedef struct {
+    /* The heap (pointers to `values` slots, the smallest kept item sits at index 0). */
+    void **heap;
+    /* The kept item copies (`k` slots of `elem_size` bytes). */
+    char *values;
+    /* The amount of items on the heap. */
+    size_t len;
+    /* The max amount of items kept. */
+    size_t k;
+    /* The size of a single item. */
+    size_t elem_size;
+    /* Comparer function (assert eq between value $0 and $1). */
+    int (*comp)(void *, void *);
+} TopK;
+
+TopK *top_k_new(size_t, size_t, int (*)(void *, void *));
+void top_k_push(TopK *, void *);
+void top_k_consume(TopK *, CIterator *);
+void top_k_merge(TopK *, TopK *);
+TopK *top_k_destroy(TopK *);
+void push_top_k_into_citerator(CIterator *, TopK *);
+CIterator *citerator_top_k(CIterator *, size_t, size_t, int (*)(void *, void *));
+
+#endif